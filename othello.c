@@ -9,18 +9,46 @@
  * (according to the rules of Othello, player black always goes first).  Note that black tiles are represented with X's and white
  * tiles are represented with O's.
  * 
- * The DEPTH_MAX parameter can be increased to make the A.I. more difficult.  It is not recommended to use a depth max setting of 7
- * or higher, as that can lead to the A.I. taking upwards of 2 minutes to make a move
+ * The DEPTH_MAX parameter (or the -d option) can be increased to make the A.I. more difficult.  It is not recommended to use a depth
+ * max setting of 7 or higher without selective search, as that can lead to the A.I. taking upwards of 2 minutes to make a move
+ * 
+ * Selective search (Multi-ProbCut) is enabled with the -s option.  Higher selectivity levels prune more of the tree based on shallow
+ * searches, so the A.I. can search deeper in the same time at a small risk of missing the best move.  The parameters used to predict
+ * deep searches from shallow ones are calibrated by running the program with the -c option and pasting the printed table into mpcTable.
+ * 
+ * The -k option shows the best moves found by the A.I. with their scores (from the perspective of the player to move) and principal
+ * variations, and entering ? instead of coordinates shows them for the human player as a hint.  Results of searches are kept in a
+ * transposition table, so the ranked alternatives cost much less than a separate search for each of them.
+ * 
+ * The A.I. search can be spread over several processes, on the same or other machines.  Start each worker process with -w and a
+ * port to listen on, then start the game with -W and a comma-separated list of the workers' host:port addresses, e.g.
+ * ./othello -w 5001 & ./othello -w 5002 & ./othello -d 8 -W localhost:5001,localhost:5002.  The root moves are then searched on
+ * the workers, and workers searching with an outdated alpha-beta window are stopped and restarted with the current one.
+ * 
+ * All memory of the A.I. (the nodes of each level of the A.I. tree and the transposition table) is allocated once at startup, so
+ * memory use is fixed while playing.  The -m option sets the total in megabytes (16 by default), and the transposition table gets
+ * whatever the nodes leave.  The -H option backs the memory with 2 MB huge pages if the system provides them, which saves misses
+ * in the translation lookaside buffer when probing a large table.  The memory used is reported at startup.
+ * 
+ * The -b option runs a benchmark instead of a game: midgame positions are searched to a fixed depth and endgame positions are solved
+ * to the end of the game, and the time, nodes searched, nodes per second and whether the best move and score are correct are printed
+ * for each, followed by a summary line to compare with other versions.  The exit status is nonzero if any result was incorrect.
+ * -b 1 runs the quick tier (about a minute), which is the number to compare before accepting a change to the A.I.; -b 2 also solves
+ * the much harder endgames of the FFO test suite, which takes hours.  Other options (e.g. -s and -m) apply to the benchmark as well,
+ * except -d.
+ * 
+ * Features of the A.I. board (tile count, frontier, potential mobility and stable tiles) are updated incrementally as moves are made
+ * and unmade.  When compiled with -DCHECK_FEATURES, they are checked against features computed from scratch after every move, which
+ * is much slower, so the check is off by default.
  * 
  * Consider the following improvements for future versions:
  * 
- * 1. Currently, when minimax function detects a leaf node, it may not actually be a leaf node.  It considers a given board to
- * be a leaf node if there are no moves available to the A.I. player, but it really should then check to see if there are moves
- * available for the human player afterwards.
+ * 1. (Done) When the player to move has no moves available, minimax function now lets the other player move again, and only treats
+ * the board as a leaf node if neither player has moves available.  Passes are shown as -- in principal variations.
  * 
  * 2. Consider increasing the score of (actual) leaf nodes by some amount if they are winning condition.  I.e., it may be better for the A.I.
- * to path towards an early, guaranteed win condition rather than whichever scenario provides the highest number of white tiles.  This
- * improvement cannot be implemented until the first improvement has been implemented.
+ * to path towards an early, guaranteed win condition rather than whichever scenario provides the highest number of white tiles.  So
+ * far, the empty tiles of a finished game are counted for the winner (as in tournament scoring).
  * 
  * 3. Somehow pass the address of the boardLocal variable at each node as a parameter to the subsequent node so that the boardAI variable
  * doesn't have to be a global variable that has to constantly be changed and then changed back.  May be able to reliably have A.I.
@@ -30,53 +58,444 @@
  * of freeing the entire tree.  That way, part of the already-loaded tree can be carried over to the A.I.'s next turn.
  */
 
+// request POSIX functions (e.g. getopt), which strict C11 does not declare, and common extensions such as MAP_ANONYMOUS for mmap
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <cs50.h>
 #include <ctype.h>
+#include <math.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <time.h>
 
 // define dimensions of square board size
 #define BOARD_MAX 8
 
-// define limit for depth of A.I. tree (higher depth means stronger A.I. opponent but longer processing time)
+// define default limit for depth of A.I. tree (higher depth means stronger A.I. opponent but longer processing time)
 #define DEPTH_MAX 6
 
+// define Multi-ProbCut parameters: shallowest remaining depth at which a cut is tried, deepest remaining depth with calibrated
+// parameters, number of game phases, number of shallow searches tried per depth and number of selectivity levels
+#define MPC_DEPTH_MIN 3
+#define MPC_DEPTH_MAX 8
+#define MPC_PHASES 4
+#define MPC_TRIES 2
+#define MPC_LEVELS 5
+
+// define default and highest limit for total memory of A.I. in megabytes (the highest keeps the transposition table below 2^32
+// entries, as needed to index it), and size of huge pages
+#define MEMORY_MAX 16
+#define MEMORY_LIMIT (64 * 1024)
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// define maximum number of levels on A.I. tree
+#define PLY_MAX (BOARD_MAX * BOARD_MAX)
+
+// define move that stands for a pass in principal variations (shown as --)
+#define PASS -1
+
+// define maximum number of worker processes and maximum length of a message between coordinator and worker processes
+#define WORKERS_MAX 64
+#define MESSAGE_MAX 512
+
+// define seconds between messages from a worker process while it searches a job, and seconds without any message after which the
+// coordinator gives up on the worker (e.g. because its machine lost power or the network was cut, which does not close the connection)
+#define HEARTBEAT_INTERVAL 1
+#define WORKER_TIMEOUT 10
+
+// define number of benchmark positions, number of benchmark tiers (each tier adds harder positions to the ones before) and depth to
+// which midgame benchmark positions are searched
+#define BENCHMARK_POSITIONS 16
+#define BENCHMARK_TIERS 2
+#define BENCHMARK_DEPTH 10
+
+// define kinds of scores stored in transposition table (exact score, or lower or upper bound of score)
+#define BOUND_EXACT 0
+#define BOUND_LOWER 1
+#define BOUND_UPPER 2
+
+// limit for depth of A.I. tree (set with -d)
+int depthMax = DEPTH_MAX;
+
+// selectivity level of A.I. search (set with -s, 0 means no selective pruning)
+int selectivity = 0;
+
+// number of best moves to show with their scores and principal variations (set with -k)
+int pvCount = 1;
+
+// limit for total memory of A.I. in megabytes (set with -m), and whether to back it with huge pages (set with -H)
+int memoryMax = MEMORY_MAX;
+bool hugePages = false;
+
+// number of nodes searched (i.e. moves made) by A.I.
+unsigned long long nodes = 0;
+
 // declare and initialize board
 int board[BOARD_MAX][BOARD_MAX];
 
 // maintain copy of board for A.I.
 int boardAI[BOARD_MAX][BOARD_MAX];
 
+// define masks of tiles in first and last column (sets of tiles are stored as 64-bit masks with bit i * BOARD_MAX + j for tile i, j)
+#define COLUMN_A 0x0101010101010101ULL
+#define COLUMN_H 0x8080808080808080ULL
+#define EDGES (0xff000000000000ffULL | COLUMN_A | COLUMN_H)
+
+// define index of player alignment in arrays of features (0 for player black, 1 for player white)
+#define PLAYER(alignment) (((alignment) + 1) / 2)
+
+// define struct for features of boardAI that are updated incrementally from the tiles flipped by each move
+typedef struct features {
+    uint64_t tileMask[2];       // tiles of each player
+    uint64_t stableMask;        // tiles that can never be flipped again
+    uint64_t hash;              // hash key of tiles (random key of each tile xor-ed together)
+    int discs;                  // number of white tiles minus number of black tiles
+    int tiles;                  // number of tiles on the board
+    int frontier[2];            // tiles of each player next to at least one empty tile
+    int potentialMobility[2];   // empty tiles next to at least one tile of the other player
+    int stable[2];              // tiles of each player that can never be flipped again
+}
+features;
+
+// maintain features of boardAI, and the features before each move (by number of tiles on the board) so that moves can be unmade
+features featuresAI;
+features featuresHistory[BOARD_MAX * BOARD_MAX];
+
+// maintain number of empty tiles on each row, column, diagonal and anti-diagonal of boardAI
+int lineEmpties[4][2 * BOARD_MAX - 1];
+
+// define checking increments along rows, columns, diagonals and anti-diagonals
+int lineX[4] = {0, 1, 1, 1};
+int lineY[4] = {1, 0, 1, -1};
+
 // variable for tracking current level on A.I. tree
 int z;
 
-// define struct node for A.I. tree
+// define struct for transposition table entry, which stores result of searching a board so that it can be reused when the board
+// is reached again (e.g. by another order of moves, in a deeper search or in the search of another root move)
+typedef struct entry {
+    uint64_t key;
+    signed char score;
+    signed char depth;
+    signed char bound;
+    signed char move;
+}
+entry;
+
+// declare random keys for hashing each player's tiles and player white to move
+uint64_t tileKeys[2][BOARD_MAX * BOARD_MAX];
+uint64_t whiteKey;
+
+// define struct for root move with its score (from perspective of player to move) and principal variation
+typedef struct rootMove {
+    int move;
+    int score;
+    bool exact;
+    int pv[PLY_MAX];
+    int pvLength;
+}
+rootMove;
+
+// define struct node for A.I. tree, with its score and the principal variation (expected sequence of best moves) found from it
 typedef struct node {
-    int boardLocal[BOARD_MAX][BOARD_MAX];
     int score;
-    int parentScore;
-    bool isFirstChild;
-    bool* firstChildAssigned;
-    struct node* children[BOARD_MAX][BOARD_MAX];
+    int pv[PLY_MAX];
+    int pvLength;
 }
 node;
 
+// A.I. memory, allocated once at startup within the memory limit: one node for each level of A.I. tree (indexed by z, since only
+// the nodes on the path being searched are needed at any time), followed by the transposition table, which gets the rest
+void* memory;
+size_t memorySize;
+node* tree;
+entry* table;
+size_t tableSize;
+
+// define struct for predicting the score of a deep search from the score of a shallow search (deep = a * shallow + b, with
+// standard deviation sigma of the error), with both scores taken from the perspective of the player to move
+typedef struct mpcParams {
+    float a;
+    float b;
+    float sigma;
+}
+mpcParams;
+
+// shallow search depths used to predict the search of each remaining depth, cheapest first (0 means no shallow search)
+int mpcShallow[MPC_DEPTH_MAX + 1][MPC_TRIES] = {
+    {0, 0}, {0, 0}, {0, 0},
+    {1, 0}, {2, 0}, {1, 3}, {2, 4}, {3, 5}, {2, 4}
+};
+
+// number of standard deviations by which a predicted score must fall outside the alpha-beta window for each selectivity level
+float mpcThreshold[MPC_LEVELS] = {0.0, 2.6, 2.0, 1.5, 1.1};
+
+// Multi-ProbCut parameters for each game phase, remaining depth and shallow search (generated by running ./othello -c 2000)
+mpcParams mpcTable[MPC_PHASES][MPC_DEPTH_MAX + 1][MPC_TRIES] = {
+    {
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.771, 1.040, 1.359}, {0.000, 0.000, 0.000}},
+        {{0.768, -0.794, 1.256}, {0.000, 0.000, 0.000}},
+        {{0.662, 1.673, 1.458}, {0.819, 0.939, 1.116}},
+        {{0.668, -1.214, 1.376}, {0.811, -0.652, 1.138}},
+        {{0.687, 1.659, 1.428}, {0.816, 0.970, 1.183}},
+        {{0.603, -1.463, 1.561}, {0.749, -0.919, 1.342}}
+    },
+    {
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.802, 0.923, 1.958}, {0.000, 0.000, 0.000}},
+        {{0.828, -0.918, 1.775}, {0.000, 0.000, 0.000}},
+        {{0.683, 1.468, 2.446}, {0.876, 0.524, 1.506}},
+        {{0.701, -1.477, 2.291}, {0.855, -0.676, 1.632}},
+        {{0.759, 1.264, 2.228}, {0.884, 0.705, 1.640}},
+        {{0.593, -1.897, 2.848}, {0.753, -1.141, 2.312}}
+    },
+    {
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.827, 0.607, 3.432}, {0.000, 0.000, 0.000}},
+        {{0.851, -1.006, 3.092}, {0.000, 0.000, 0.000}},
+        {{0.668, 1.478, 4.952}, {0.897, 0.383, 2.874}},
+        {{0.734, -1.434, 4.881}, {0.947, -0.224, 2.902}},
+        {{0.816, 0.954, 4.957}, {0.995, 0.050, 2.997}},
+        {{0.609, -1.326, 7.289}, {0.894, 0.117, 5.711}}
+    },
+    {
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.000, 0.000, 0.000}, {0.000, 0.000, 0.000}},
+        {{0.879, 0.235, 6.042}, {0.000, 0.000, 0.000}},
+        {{0.967, 1.672, 7.622}, {0.000, 0.000, 0.000}},
+        {{0.773, 0.703, 11.119}, {1.057, -0.901, 7.057}},
+        {{0.966, 3.374, 12.154}, {1.103, 1.764, 7.186}},
+        {{1.100, -1.442, 11.252}, {1.124, -1.122, 6.079}},
+        {{0.956, 5.255, 15.517}, {1.152, 3.697, 11.071}}
+    }
+};
+
+// define struct for benchmark position with its tier, tiles (X for black, O for white and - for empty, from A1 to H1, then A2 to H2
+// and so on), player to move, depth to search (0 means to the end of the game), best moves and score (from perspective of player to
+// move)
+typedef struct position {
+    int tier;
+    char* name;
+    char* tiles;
+    int alignment;
+    int depth;
+    char* bestMoves;
+    int score;
+}
+position;
+
+// benchmark positions, by tier: midgame positions from random games, searched to a fixed depth with best moves and scores found by
+// full-width search of every move, and endgames from random games, solved to the end of the game with best moves and scores found
+// by a separate endgame solver; harder endgames are in the second tier along with endgames from the FFO test suite
+// (www.radagast.se/othello/ffotest.html) with their published solutions
+position benchmark[BENCHMARK_POSITIONS] = {
+    {1, "Midgame 16", "---X-------X-X----OOX------XX-----OXXX----X-----OOO-------------", -1, BENCHMARK_DEPTH, "A8 C4 B5", -2},
+    {1, "Midgame 20", "-------------XXX--XOO-X---XXOOOX---XOOO---XXX-------------------", -1, BENCHMARK_DEPTH, "H5", 2},
+    {1, "Midgame 24", "---XXO---OOOO----OOOX-X--OOOXX---O-OXX-----O-O--------O---------", -1, BENCHMARK_DEPTH, "G1", -2},
+    {1, "Midgame 28", "--O-X-----XOXX--O--XOXX-XOOXXO-X-OOXX-O--XX--X-O-X--------------", -1, BENCHMARK_DEPTH, "A2 A6", -2},
+    {1, "Midgame 32", "---XO----O-OO-O---OXOXX-OXXOOXX--XXXO----XO-XOX---O-OOO----O----", -1, BENCHMARK_DEPTH, "E8 G8 F1 C1 H1 C8", -10},
+    {1, "Midgame 36", "X-XOO----XOOO-----XXXXX---XXX-X---XXXXXO--XOXOOO---O-OO----OOOO-", -1, BENCHMARK_DEPTH, "H8 F1", 0},
+    {1, "Endgame 16a", "--OOOXXX-O-OOOXOOXOOOXO-OOXXOXOO-OOXXOXO-XOOXOX----OOXX---O--OXO", -1, 0, "H3 A5", 30},
+    {1, "Endgame 16b", "----O-X-X---OOO-XXO-X-O-XXOXXXO-XXOXXOOOOOOXOXOX-XXOOOX-XXXXXXXX", -1, 0, "A7", 42},
+    {1, "Endgame 17a", "OX-OO-O--OXOOO-X-OOOOOXOOOOOXXOOO-OXXX--OXXOXXX--XXXXX---XXX-O--", 1, 0, "H1", 32},
+    {2, "Endgame 17b", "--OXXOX---XXXXXX-OXXXXXX-XOOXOOOXX-XXXOO--XXXX-O---OOOOO---OOOOO", 1, 0, "C5 A6", 26},
+    {2, "Endgame 18a", "O-X-O----O-O--O-O-O-OOOXOOXXOOOOOXXXOXOOOOOXOX-OOXXOXXX--X-OOX--", -1, 0, "H1 F2 D3 C8", -18},
+    {2, "Endgame 18b", "O-OOOOO--OOOOOO--XXXXO-----OXXO-OOOOOOOO-O-OXXOXO-X-OOX--XXXXO-X", -1, 0, "G8", 36},
+    {2, "FFO #40", "O--OOOOX-OOOOOOXOOXXOOOXOOXOOOXXOOOOOOXX---OOOOX----O--X--------", -1, 0, "A2", 38},
+    {2, "FFO #41", "-OOOOO----OOOOX--OOOOOO-XXXXXOO--XXOOX--OOXOXX----OXXO---OOO--O-", -1, 0, "H4", 0},
+    {2, "FFO #44", "--O-X-O---O-XO-O-OOXXXOOOOOOXXXOOOOOXX--XXOOXO----XXXX-----XXX--", 1, 0, "D2 B8", -14},
+    {2, "FFO #45", "---XXXX-X-XXXO--XXOXOO--XXXOXO--XXOXXO---OXXXOO-O-OOOO------OO--", -1, 0, "B2", 6}
+};
+
+// define struct for connection between coordinator and worker process, with text received but not yet read, and (in coordinator)
+// job being searched by worker, bound it is searched with, whether it has been asked to stop, job to resume once it has stopped and
+// when the worker was last heard from (or in worker, when the coordinator was last told that the job is still being searched)
+typedef struct connection {
+    int socket;
+    char buffer[MESSAGE_MAX];
+    int length;
+    int job;
+    int bound;
+    bool stopping;
+    int resume;
+    time_t heard;
+}
+connection;
+
+// in coordinator, connections to worker processes (set with -W)
+connection workers[WORKERS_MAX];
+int workerCount = 0;
+
+// in worker process, connection to coordinator, job being searched and whether coordinator has asked to stop it
+connection* coordinator = NULL;
+int currentJob = -1;
+bool stopSearch = false;
+
 // define function prototypes
 void printboard(void);
 bool isLegal(int i, int j, int alignment, bool flip);
 bool isAnyMoveAvailable(int alignment);
 int boardCount(void);
 void getAlignment(int alignment, char* player);
-int minimax(node* currentNode, int i, int j, int parentScore, bool* parentsFirstChildAssigned);
-bool isLegalAI(int i, int j, int alignment);
+void moveText(int move, char* text);
+int minimax(node* currentNode, int i, int j, int alignment, int depth, int alpha, int beta);
+int search(node* currentNode, int alignment, int depth, int alpha, int beta);
+bool probCut(node* currentNode, int alignment, int depth, int alpha, int beta, int* score);
+int mpcPhase(void);
+void calibrate(int positions);
+int runBenchmark(int tier);
+bool initMemory(void);
+int analyze(int alignment, int depth, int count, rootMove* moves);
+int rankBound(rootMove* moves, int legalMoves, int count);
+void rankMoves(rootMove* moves, int legalMoves);
+void printAnalysis(int alignment, int depth, int count, rootMove* moves, int legalMoves);
+void searchRootMove(rootMove* move, int alignment, int depth, int bound);
+int distribute(int alignment, int depth, int count, rootMove* moves);
+bool connectWorkers(char* addresses);
+void dropWorker(connection* worker, bool* waiting);
+int runWorker(int port);
+void checkStop(void);
+int receiveLine(connection* c, char* line, bool wait);
+bool sendLine(int socket, char* line);
+uint64_t isLegalAI(int i, int j, int alignment);
 bool isAnyMoveAvailableAI(int alignment);
 int boardCountAI(void);
+int finalCountAI(void);
+uint64_t makeMoveAI(int i, int j, int alignment);
+void unmakeMoveAI(int i, int j, uint64_t flips);
+void loadBoard(char* tiles);
+void loadBoardAI(void);
+void initFeaturesAI(void);
+void computeFeaturesAI(features* f);
+void addFeaturesAI(uint64_t tiles, int sign);
+void updateStabilityAI(int i, int j, uint64_t flips);
+bool isStableAI(int i, int j, uint64_t stableMask, bool full[4]);
+int lineIndex(int i, int j, int line);
+uint64_t lineMaskAI(int i, int j, int line);
+uint64_t neighbours(uint64_t tiles);
+uint64_t shiftTiles(uint64_t tiles, int direction);
+void checkFeaturesAI(void);
 
 /**
  * main game function
  */
-int main(void)
+int main(int argc, char* argv[])
 {
+    // declare variable for number of calibration positions (zero means play a game instead of calibrating)
+    int positions = 0;
+    
+    // declare variable for benchmark tier to run instead of playing a game (zero means play a game)
+    int tier = 0;
+    
+    // declare variables for port to listen on as worker process and addresses of worker processes to use as coordinator
+    int port = 0;
+    char* addresses = NULL;
+    
+    // parse command-line options
+    int option;
+    while ((option = getopt(argc, argv, "d:s:k:m:Hc:b:w:W:")) != -1)
+    {
+        switch (option)
+        {
+            case 'd' :
+                depthMax = atoi(optarg);
+                break;
+            case 's' :
+                selectivity = atoi(optarg);
+                break;
+            case 'k' :
+                pvCount = atoi(optarg);
+                break;
+            case 'm' :
+                memoryMax = atoi(optarg);
+                break;
+            case 'H' :
+                hugePages = true;
+                break;
+            case 'c' :
+                positions = atoi(optarg);
+                break;
+            case 'b' :
+                tier = atoi(optarg);
+                break;
+            case 'w' :
+                port = atoi(optarg);
+                break;
+            case 'W' :
+                addresses = optarg;
+                break;
+            default :
+                depthMax = 0;
+        }
+    }
+    
+    // check that options are within range
+    if (optind != argc || depthMax < 1 || depthMax > BOARD_MAX * BOARD_MAX || selectivity < 0 || selectivity >= MPC_LEVELS
+        || pvCount < 1 || pvCount > BOARD_MAX * BOARD_MAX || memoryMax < 1 || memoryMax > MEMORY_LIMIT || positions < 0 || tier < 0
+        || tier > BENCHMARK_TIERS || port < 0
+        || port > 65535)
+    {
+        printf("Usage: %s [-d depth] [-s selectivity (0-%d)] [-k best moves to show] [-m memory in MB (1-%d)] [-H (use huge pages)]\n"
+            "       [-c calibration positions] [-b benchmark tier (1-%d)] [-w worker port] [-W worker host:port,...]\n", argv[0], MPC_LEVELS - 1,
+            MEMORY_LIMIT, BENCHMARK_TIERS);
+        return 1;
+    }
+    
+    // ignore broken connections to other processes instead of terminating, since they are detected when sending or receiving
+    signal(SIGPIPE, SIG_IGN);
+    
+    // allocate all memory for A.I. at once
+    if (!initMemory())
+    {
+        printf("Could not allocate %d MB of memory for A.I.\n", memoryMax);
+        return 1;
+    }
+    
+    // if requested, calibrate Multi-ProbCut parameters instead of playing a game
+    if (positions > 0)
+    {
+        calibrate(positions);
+        return 0;
+    }
+    
+    // if requested, run benchmark instead of playing a game (exit status tells whether all results were correct)
+    if (tier > 0)
+    {
+        return (runBenchmark(tier) == 0) ? 0 : 1;
+    }
+    
+    // if requested, run as worker process for a coordinator instead of playing a game
+    if (port > 0)
+    {
+        return runWorker(port);
+    }
+    
+    // if requested, connect to worker processes to search A.I. moves on
+    if (addresses != NULL && !connectWorkers(addresses))
+    {
+        return 1;
+    }
+    
     // fill board with zeroes
     for (int i = 0; i < BOARD_MAX; i++)
     {
@@ -133,6 +552,17 @@ int main(void)
             char* coord = GetString();
             printf("\n");
             
+            // if user asks for a hint, show best moves for human player instead
+            if (strcmp(coord, "?") == 0)
+            {
+                free(coord);
+                loadBoardAI();
+                rootMove moves[BOARD_MAX * BOARD_MAX];
+                int legalMoves = (workerCount > 0) ? distribute(alignment, depthMax, pvCount, moves) : analyze(alignment, depthMax, pvCount, moves);
+                printAnalysis(alignment, depthMax, pvCount, moves, legalMoves);
+                continue;
+            }
+            
             // check length of user-inputted string
             int k;
             for (k = 0; *(coord + k) != '\0'; k++);
@@ -168,80 +598,23 @@ int main(void)
         else
         {
             
-            // set depth variable to zero
-            z = 0;
-            
-            // create root node
-            node* root = malloc(sizeof(node));
+            // copy board to boardAI variable and compute its features
+            loadBoardAI();
             
-             // copy board to boardAI variable and boardLocal
-            for (int m = 0; m < BOARD_MAX; m++)
-            {
-                for (int n = 0; n < BOARD_MAX; n++)
-                {
-                    boardAI[m][n] = board[m][n];
-                    root->boardLocal[m][n] = board[m][n];
-                }
-            }
+            // search all root moves (on worker processes if there are any) and play best one
+            rootMove moves[BOARD_MAX * BOARD_MAX];
+            int legalMoves = (workerCount > 0) ? distribute(alignment, depthMax, pvCount, moves) : analyze(alignment, depthMax, pvCount, moves);
+            i = moves[0].move / BOARD_MAX;
+            j = moves[0].move % BOARD_MAX;
             
-            // initialize score to 65 (65 arbitrarily chosen as default value because possible range for score variable is -64 to 64)
-            root->score = 65;
-            
-            // malloc variable to store whether first child has been assigned and initialize value pointed to by variable to false (i.e., first child not yet assigned)
-            root->firstChildAssigned = malloc(sizeof(bool));
-            *(root->firstChildAssigned) = false;
-            
-            // declare variable for returned score
-            int returnScore;
+            printf("%c%c\n\n", j + 'A', i + '1');
             
-            // minimax all child nodes recursively
-            for (int m = 0; m < BOARD_MAX; m++)
+            // if requested, show alternatives to move
+            if (pvCount > 1)
             {
-                for (int n = 0; n < BOARD_MAX; n++)
-                {
-                    
-                    // if return score is not 65 (default value), consider setting score as return score
-                    root->children[m][n] = malloc(sizeof(node));
-                    returnScore = minimax(root->children[m][n], m, n, root->score, root->firstChildAssigned);
-                    free(root->children[m][n]);
-                    
-                    // change board back to original configuration after running minimax
-                    for (int a = 0; a < BOARD_MAX; a++)
-                    {
-                        for (int b = 0; b < BOARD_MAX; b++)
-                        {
-                            boardAI[a][b] = root->boardLocal[a][b]; // MAJOR room for improvement here: could check if legal (which flips tiles on boardAI) right before executing minimax-->this would make it so these two for loops don't have to be run after EVERY minimax
-                        }
-                    }
-                    
-                    // if returned score is not default value, consider changing score of root node
-                    if (returnScore != 65)
-                    {
-                    
-                        // if current score is default or if returned score is higher than current score, set returned score as score or root node and save i and j
-                        if (root->score == 65)
-                        {
-                            root->score = returnScore;
-                            i = m;
-                            j = n;
-                        }
-                        else if (returnScore > root->score)
-                        {
-                            root->score = returnScore;
-                            i = m;
-                            j = n;
-                        }
-                        
-                    }
-                    
-                }
+                printAnalysis(alignment, depthMax, pvCount, moves, legalMoves);
             }
             
-            free(root->firstChildAssigned);
-            free(root);
-            
-            printf("%c%c\n\n", j + 'A', i + '1');
-            
         }
         
         // check if move is legal
@@ -267,8 +640,16 @@ int main(void)
         printf("Player %s is the winner!\n", player);
     }
 
-    // free variable for storing player alignment string
+    // free variable for storing player alignment string and memory of A.I., and disconnect from worker processes
     free(player);
+    munmap(memory, memorySize);
+    for (int w = 0; w < workerCount; w++)
+    {
+        if (workers[w].socket >= 0)
+        {
+            close(workers[w].socket);
+        }
+    }
     
     // end program
     return 0;
@@ -521,136 +902,98 @@ void getAlignment(int alignment, char* player)
 }
 
 /**
- * iterate through A.I. decision tree while malloc-ing and freeing nodes as needed
+ * put coordinates of move into text (e.g. D3, or -- for a pass), which must have room for 3 characters
  */
-int minimax(node* currentNode, int i, int j, int parentScore, bool* parentsFirstChildAssigned)
+void moveText(int move, char* text)
+{
+    if (move == PASS)
+    {
+        sprintf(text, "--");
+    }
+    else
+    {
+        sprintf(text, "%c%c", move % BOARD_MAX + 'A', move / BOARD_MAX + '1');
+    }
+}
+
+/**
+ * iterate through A.I. decision tree, using the preallocated node of each level
+ * 
+ * Plays move (i, j) for player alignment and returns the score of the resulting board searched to the given remaining depth.
+ * Scores are always from the perspective of player white (the A.I.), who maximizes while player black minimizes.  Scores at or
+ * below alpha or at or above beta only bound the true score, since the search stops as soon as it can prove that the node will
+ * not be chosen (alpha-beta principle).
+ */
+int minimax(node* currentNode, int i, int j, int alignment, int depth, int alpha, int beta)
 {
-    
-    // set alignment based on tree depth (even-numbered tree depth indicates same alignment as AI, odd indicates opposite alignment)
-    int alignment;
-    alignment = (z % 2 == 0) ? 1 : -1;
     
     // execute action corresponding to child node if move is legal
-    if(isLegalAI(i, j, alignment))
+    uint64_t flips = makeMoveAI(i, j, alignment);
+    if (flips != 0)
     {
         
-        // increase depth by 1 and switch alignment
+        // count node, and in worker process regularly check whether coordinator has asked to stop
+        nodes++;
+        if (coordinator != NULL && (nodes & 4095) == 0)
+        {
+            checkStop();
+        }
+        
+        // increase depth by 1, switch alignment and clear principal variation
         z++;
         alignment *= -1;
+        currentNode->pvLength = 0;
         
-        // store current board in struct for current node
-        for (int m = 0; m < BOARD_MAX; m++)
+        // if max depth has been reached, determine score of current board (scored like any other finished game if neither player
+        // has moves available, so that a finished game gets the same score whether or not it is reached at max depth)
+        int score;
+        if (depth <= 0)
         {
-            for (int n = 0; n < BOARD_MAX; n++)
+            if (featuresAI.tiles < BOARD_MAX * BOARD_MAX && !isAnyMoveAvailableAI(alignment) && !isAnyMoveAvailableAI(-alignment))
             {
-                currentNode->boardLocal[m][n] = boardAI[m][n];
+                score = finalCountAI();
+            }
+            else
+            {
+                score = boardCountAI();
             }
         }
         
-        // use function argument to determine whether current node is first child node of parent
-        if (*parentsFirstChildAssigned == false)
-        {
-            *parentsFirstChildAssigned = true;
-            currentNode->isFirstChild = true;
-        }
-        else
-        {
-            currentNode->isFirstChild = false;
-        }
-        
-        // set current node score to default value
-        currentNode->score = 65;
-        
-        // if max depth has been reached or if there are no more moves available (i.e., leaf node has been reached), determine score of current board
-        if (z >= DEPTH_MAX || !isAnyMoveAvailableAI(alignment))
+        // else if there are moves available, return score based on scores of children
+        else if (isAnyMoveAvailableAI(alignment))
         {
-            z--;
-            return boardCountAI();
+            score = search(currentNode, alignment, depth, alpha, beta);
         }
         
-        // else return score based on scores of children and parent nodes
-        else
+        // else if only the other player has moves available, player passes and the other player moves again (a pass does not count
+        // toward the depth, since it does not fill a tile)
+        else if (isAnyMoveAvailableAI(-alignment))
         {
-            int returnScore;
+            score = search(currentNode, -alignment, depth, alpha, beta);
             
-            // malloc variable to store whether first child has been assigned to current node
-            currentNode->firstChildAssigned = malloc(sizeof(bool));
-            *(currentNode->firstChildAssigned) = false;
-        
-            for (int m = 0; m < BOARD_MAX; m++)
+            // put pass in front of principal variation, so that it shows which player makes each move
+            if (currentNode->pvLength > 0 && currentNode->pvLength < PLY_MAX)
             {
-                for (int n = 0; n < BOARD_MAX; n++)
+                for (int p = currentNode->pvLength; p > 0; p--)
                 {
-                    
-                    // minimax child node and get returned score
-                    currentNode->children[m][n] = malloc(sizeof(node));
-                    returnScore = minimax(currentNode->children[m][n], m, n, currentNode->score, currentNode->firstChildAssigned);
-                    int debug = z; // DEBUG
-                    if (false) // DEBUG
-                        printf("%d\n", debug); // DEBUG
-                    free(currentNode->children[m][n]);
-                    
-                    // change board back to original configuration after running minimax
-                    for (int a = 0; a < BOARD_MAX; a++)
-                    {
-                        for (int b = 0; b < BOARD_MAX; b++)
-                        {
-                            boardAI[a][b] = currentNode->boardLocal[a][b]; // MAJOR room for improvement here: could check if legal (which flips tiles on boardAI) right before executing minimax-->this would make it so these two for loops don't have to be run after EVERY minimax
-                        }
-                    }
-                    
-                    // if returned score is not default value, calculate score for current node based on children and parent nodes
-                    if (returnScore != 65)
-                    {
-                        
-                        // if current node is not first child, break if constrained by current alignment and parent score so that default value for score is returned (alpha-beta principle)
-                        if (!currentNode->isFirstChild)
-                        {
-                            if (alignment != 1)
-                            {
-                                if (returnScore < parentScore)
-                                {
-                                    break;
-                                }
-                            }
-                            else
-                            {
-                                if (returnScore > parentScore)
-                                {
-                                    break;
-                                }
-                            }
-                        }
-                        
-                        // if not constrained (see above), set current score to return score based on alignment
-                        if (alignment != 1)
-                        {
-                            if (currentNode->score == 65 || (returnScore < currentNode->score && currentNode->score != 65))
-                            {
-                                currentNode->score = returnScore;
-                            }
-                            
-                        }
-                        else
-                        {
-                            if (currentNode->score == 65 || returnScore > currentNode->score)
-                            {
-                                currentNode->score = returnScore;
-                            }
-                        }
-                        
-                    }
-                    
+                    currentNode->pv[p] = currentNode->pv[p - 1];
                 }
+                currentNode->pv[0] = PASS;
+                currentNode->pvLength++;
             }
-            
-            // subtract depth level and return score of node
-            free(currentNode->firstChildAssigned);
-            z--;
-            return currentNode->score;
-            
         }
         
+        // else game is over (i.e., leaf node has been reached), so determine final score
+        else
+        {
+            score = finalCountAI();
+        }
+        
+        // undo move, subtract depth level and return score of node
+        unmakeMoveAI(i, j, flips);
+        z--;
+        return score;
+        
     }
     
     // else (if not legal) return default value of 65
@@ -662,87 +1005,1227 @@ int minimax(node* currentNode, int i, int j, int parentScore, bool* parentsFirst
 }
 
 /**
- * check if move is legal and flip affected pieces
+ * minimax each child of current node for player alignment to move, returning the best score for player alignment (or the default
+ * value of 65 if player alignment has no legal moves)
+ * 
+ * Board of current node must be in boardAI, and is left unchanged on return.  The principal variation of the current level is set
+ * if the score is within the alpha-beta window.
  */
-bool isLegalAI(int i, int j, int alignment)
+int search(node* currentNode, int alignment, int depth, int alpha, int beta)
 {
     
-    // check to see if the tile is already full
-    if (boardAI[i][j] != 0)
+    // clear principal variation of current node
+    currentNode->pvLength = 0;
+    
+    // stable tiles can never be flipped, so every board reached from this one has at least the stable tiles of each player, which
+    // bounds the score; return bound if it already proves that the node will not be chosen
+    int lowest = 2 * featuresAI.stable[PLAYER(1)] - BOARD_MAX * BOARD_MAX;
+    int highest = BOARD_MAX * BOARD_MAX - 2 * featuresAI.stable[PLAYER(-1)];
+    if (lowest >= beta)
     {
-        return false;
+        return lowest;
+    }
+    if (highest <= alpha)
+    {
+        return highest;
     }
     
-    // declare and initialize variable for returning legality of move
-    bool legality = false;
+    // look up board in transposition table, and return stored score if it already proves that the node will not be chosen (the
+    // table size need not be a power of 2, so the high 32 bits of the key times the size, divided by 2^32, are used as index)
+    uint64_t key = featuresAI.hash ^ ((alignment == 1) ? whiteKey : 0);
+    entry* stored = &table[(size_t) (((uint64_t) (uint32_t) (key >> 32) * tableSize) >> 32)];
+    int hashMove = -1;
+    if (stored->key == key)
+    {
+        hashMove = stored->move;
+        if (stored->depth >= depth)
+        {
+            if ((stored->bound != BOUND_UPPER && stored->score >= beta) || (stored->bound != BOUND_LOWER && stored->score <= alpha))
+            {
+                return stored->score;
+            }
+        }
+    }
     
-    // remember coordinates of tile to be checked
-    int i_origin = i;
-    int j_origin = j;
+    // return bound if shallow searches predict that the node will not be chosen
+    int score;
+    if (probCut(currentNode, alignment, depth, alpha, beta, &score))
+    {
+        return score;
+    }
     
-    // declare variables to store checking direction
-    int x;
-    int y;
+    // remember original window to determine kind of score to store in transposition table
+    int alphaOriginal = alpha;
+    int betaOriginal = beta;
     
-    // iterate over possible horizontal checking increments (i.e., left, right or none)
-    for (int m = 0; m < 3; m++)
+    // set current node score to default value
+    currentNode->score = 65;
+    int bestMove = -1;
+    
+    int returnScore;
+    node* child = &tree[z + 1];
+    
+    // iterate over each tile, trying best move stored in transposition table first
+    for (int k = -1; k < BOARD_MAX * BOARD_MAX; k++)
     {
+        int move = (k == -1) ? hashMove : k;
+        if (move == -1 || (k != -1 && move == hashMove))
+        {
+            continue;
+        }
+        int m = move / BOARD_MAX;
+        int n = move % BOARD_MAX;
         
-        // determine horizontal checking increment
-        switch (m)
+        // minimax child node and get returned score
+        returnScore = minimax(child, m, n, alignment, depth - 1, alpha, beta);
+        
+        // if search has been stopped, score is meaningless, so stop searching
+        if (stopSearch)
         {
-            case 0 :
-                x = -1;
-                break;
-            case 1 :
-                x = 0;
-                break;
-            case 2 :
-                x = 1;
+            break;
         }
         
-        // check if column to be checked is out of bounds
-        if ((i_origin + x) < 0 || (i_origin + x) >= BOARD_MAX)
+        // if move was not legal, there is nothing to do
+        if (returnScore == 65)
         {
             continue;
         }
         
-        // iterate over possible vertical checking increments (i.e., up, down or none)
-        for (int n = 0; n < 3; n++)
+        // set current score to return score based on alignment, remembering best move
+        if (alignment != 1)
         {
-            
-            // determine vertical checking increment
-            switch (n)
+            if (currentNode->score == 65 || returnScore < currentNode->score)
             {
-                case 0 :
-                    y = -1;
-                    break;
-                case 1 :
-                    y = 0;
-                    break;
-                case 2 :
-                    y = 1;
+                currentNode->score = returnScore;
+                bestMove = move;
             }
-            
-            if (x == 0 && y == 0)
+        }
+        else
+        {
+            if (currentNode->score == 65 || returnScore > currentNode->score)
             {
-                continue;
+                currentNode->score = returnScore;
+                bestMove = move;
             }
-            
-            // check if row to be checked is out of bounds
-            if ((j_origin + y) < 0 || (j_origin + y) >= BOARD_MAX)
+        }
+        
+        // if score is within window, narrow window accordingly and extend principal variation of child with move
+        if ((alignment == 1) ? returnScore > alpha : returnScore < beta)
+        {
+            if (alignment == 1)
             {
-                continue;
+                alpha = returnScore;
             }
-            
-            i = i_origin;
-            j = j_origin;
-            
+            else
+            {
+                beta = returnScore;
+            }
+            currentNode->pv[0] = move;
+            for (int p = 0; p < child->pvLength; p++)
+            {
+                currentNode->pv[p + 1] = child->pv[p];
+            }
+            currentNode->pvLength = child->pvLength + 1;
+        }
+        
+        // if window is empty, the other player will never allow this node to be reached, so stop searching (alpha-beta principle)
+        if (alpha >= beta)
+        {
+            break;
+        }
+        
+    }
+    
+    // store score in transposition table, unless search was stopped or it would replace a deeper search of the same board
+    if (currentNode->score != 65 && !stopSearch && (stored->key != key || stored->depth <= depth))
+    {
+        stored->key = key;
+        stored->score = currentNode->score;
+        stored->depth = depth;
+        if (currentNode->score <= alphaOriginal)
+        {
+            stored->bound = BOUND_UPPER;
+        }
+        else if (currentNode->score >= betaOriginal)
+        {
+            stored->bound = BOUND_LOWER;
+        }
+        else
+        {
+            stored->bound = BOUND_EXACT;
+        }
+        stored->move = bestMove;
+    }
+    
+    return currentNode->score;
+    
+}
+
+/**
+ * try to prune current node with Multi-ProbCut
+ * 
+ * A search to a shallow depth is used to predict the score of the search to the full remaining depth.  If the predicted score
+ * falls outside the alpha-beta window by more than the number of standard deviations set by the selectivity level, the node is
+ * very unlikely to be chosen, so the bound is stored in score and true is returned without searching to the full depth.  Several
+ * shallow depths are tried, cheapest first.  Board of current node must be in boardAI.
+ */
+bool probCut(node* currentNode, int alignment, int depth, int alpha, int beta, int* score)
+{
+    
+    // only prune if selective search is enabled and remaining depth is high enough to be worth a shallow search
+    if (selectivity == 0 || depth < MPC_DEPTH_MIN)
+    {
+        return false;
+    }
+    
+    // convert window to perspective of player to move, since parameters are calibrated from that perspective
+    int lower = (alignment == 1) ? alpha : -beta;
+    int upper = (alignment == 1) ? beta : -alpha;
+    
+    // depths beyond calibrated range reuse the parameters of the deepest calibrated depth with equally deeper shallow searches
+    int height = (depth > MPC_DEPTH_MAX) ? MPC_DEPTH_MAX : depth;
+    int phase = mpcPhase();
+    float t = mpcThreshold[selectivity];
+    
+    for (int k = 0; k < MPC_TRIES; k++)
+    {
+        
+        // skip unused shallow searches and parameters which cannot predict anything
+        mpcParams* params = &mpcTable[phase][height][k];
+        if (mpcShallow[height][k] == 0 || params->a <= 0)
+        {
+            continue;
+        }
+        int shallow = mpcShallow[height][k] + depth - height;
+        
+        // if shallow score reaches bound, deep score is likely at or above upper (null window search, so only bound is checked)
+        int bound = (int) ceil((upper + t * params->sigma - params->b) / params->a);
+        if (bound > -64 && bound <= 64)
+        {
+            int shallowScore = alignment * search(currentNode, alignment, shallow, (alignment == 1) ? bound - 1 : -bound, (alignment == 1) ? bound : -bound + 1);
+            if (shallowScore >= bound)
+            {
+                *score = alignment * upper;
+                return true;
+            }
+        }
+        
+        // if shallow score does not exceed bound, deep score is likely at or below lower
+        bound = (int) floor((lower - t * params->sigma - params->b) / params->a);
+        if (bound >= -64 && bound < 64)
+        {
+            int shallowScore = alignment * search(currentNode, alignment, shallow, (alignment == 1) ? bound : -bound - 1, (alignment == 1) ? bound + 1 : -bound);
+            if (shallowScore <= bound)
+            {
+                *score = alignment * lower;
+                return true;
+            }
+        }
+        
+    }
+    
+    return false;
+    
+}
+
+/**
+ * determine game phase of boardAI for Multi-ProbCut parameters based on number of tiles on the board
+ */
+int mpcPhase(void)
+{
+    return (featuresAI.tiles - 4) * MPC_PHASES / (BOARD_MAX * BOARD_MAX - 3);
+}
+
+/**
+ * calibrate Multi-ProbCut parameters and print them as a table to be pasted into the source
+ * 
+ * Plays random games and searches positions taken from them both to each calibrated depth and to the shallow depths used to
+ * predict it.  The deep scores are fitted against the shallow scores by linear regression for each game phase, and the standard
+ * deviation of the error of the fit is used as sigma.
+ */
+void calibrate(int positions)
+{
+    
+    // declare sums for linear regression of deep scores (y) against shallow scores (x)
+    static double count[MPC_PHASES][MPC_DEPTH_MAX + 1][MPC_TRIES];
+    static double sumX[MPC_PHASES][MPC_DEPTH_MAX + 1][MPC_TRIES];
+    static double sumY[MPC_PHASES][MPC_DEPTH_MAX + 1][MPC_TRIES];
+    static double sumXY[MPC_PHASES][MPC_DEPTH_MAX + 1][MPC_TRIES];
+    static double sumXX[MPC_PHASES][MPC_DEPTH_MAX + 1][MPC_TRIES];
+    static double sumYY[MPC_PHASES][MPC_DEPTH_MAX + 1][MPC_TRIES];
+    
+    // calibration searches must not be selective themselves
+    selectivity = 0;
+    
+    // use fixed seed so that calibration is reproducible
+    srand(2016);
+    
+    node* root = &tree[0];
+    
+    for (int p = 0; p < positions; p++)
+    {
+        
+        // set up starting board
+        for (int i = 0; i < BOARD_MAX; i++)
+        {
+            for (int j = 0; j < BOARD_MAX; j++)
+            {
+               board[i][j] = 0;
+            }
+        }
+        board[3][3] = 1;
+        board[3][4] = -1;
+        board[4][3] = -1;
+        board[4][4] = 1;
+        
+        // play random moves up to random number of moves, passing when there is no legal move and starting over when game ends
+        int alignment = -1;
+        int moves = rand() % (BOARD_MAX * BOARD_MAX - 4 - MPC_DEPTH_MIN);
+        for (int k = 0; k < moves; k++)
+        {
+            if (!isAnyMoveAvailable(alignment))
+            {
+                alignment *= -1;
+                if (!isAnyMoveAvailable(alignment))
+                {
+                    break;
+                }
+            }
+            int legal[BOARD_MAX * BOARD_MAX];
+            int legalCount = 0;
+            for (int i = 0; i < BOARD_MAX; i++)
+            {
+                for (int j = 0; j < BOARD_MAX; j++)
+                {
+                    if (isLegal(i, j, alignment, false))
+                    {
+                        legal[legalCount++] = i * BOARD_MAX + j;
+                    }
+                }
+            }
+            int move = legal[rand() % legalCount];
+            isLegal(move / BOARD_MAX, move % BOARD_MAX, alignment, true);
+            alignment *= -1;
+        }
+        if (!isAnyMoveAvailable(alignment))
+        {
+            p--;
+            continue;
+        }
+        
+        // copy board to boardAI variable and compute its features
+        loadBoardAI();
+        int phase = mpcPhase();
+        
+        // search position to each depth (from perspective of player to move), then add pairs of deep and shallow scores to sums
+        int scores[MPC_DEPTH_MAX + 1];
+        for (int depth = 1; depth <= MPC_DEPTH_MAX; depth++)
+        {
+            z = 0;
+            scores[depth] = alignment * search(root, alignment, depth, -65, 65);
+        }
+        for (int depth = MPC_DEPTH_MIN; depth <= MPC_DEPTH_MAX; depth++)
+        {
+            for (int k = 0; k < MPC_TRIES; k++)
+            {
+                if (mpcShallow[depth][k] == 0)
+                {
+                    continue;
+                }
+                double x = scores[mpcShallow[depth][k]];
+                double y = scores[depth];
+                count[phase][depth][k]++;
+                sumX[phase][depth][k] += x;
+                sumY[phase][depth][k] += y;
+                sumXY[phase][depth][k] += x * y;
+                sumXX[phase][depth][k] += x * x;
+                sumYY[phase][depth][k] += y * y;
+            }
+        }
+        
+        fprintf(stderr, "Calibrated %d of %d positions\r", p + 1, positions);
+    }
+    fprintf(stderr, "\n");
+    
+    // fit parameters for each phase, depth and shallow search, and print table (unused and underdetermined entries are zero)
+    for (int phase = 0; phase < MPC_PHASES; phase++)
+    {
+        printf("    {\n");
+        for (int depth = 0; depth <= MPC_DEPTH_MAX; depth++)
+        {
+            printf("        {");
+            for (int k = 0; k < MPC_TRIES; k++)
+            {
+                double n = count[phase][depth][k];
+                double a = 0;
+                double b = 0;
+                double sigma = 0;
+                double det = n * sumXX[phase][depth][k] - sumX[phase][depth][k] * sumX[phase][depth][k];
+                if (n > 2 && det > 0)
+                {
+                    a = (n * sumXY[phase][depth][k] - sumX[phase][depth][k] * sumY[phase][depth][k]) / det;
+                    b = (sumY[phase][depth][k] - a * sumX[phase][depth][k]) / n;
+                    double residual = sumYY[phase][depth][k] - 2 * a * sumXY[phase][depth][k] - 2 * b * sumY[phase][depth][k]
+                        + a * a * sumXX[phase][depth][k] + 2 * a * b * sumX[phase][depth][k] + n * b * b;
+                    sigma = sqrt(fmax(residual, 0) / (n - 2));
+                }
+                printf("{%.3f, %.3f, %.3f}%s", a, b, sigma, (k < MPC_TRIES - 1) ? ", " : "");
+            }
+            printf("}%s\n", (depth < MPC_DEPTH_MAX) ? "," : "");
+        }
+        printf("    }%s\n", (phase < MPC_PHASES - 1) ? "," : "");
+    }
+    
+}
+
+/**
+ * search each benchmark position up to given tier with the current options (except depth) and print the best move and score found, whether they
+ * are correct, the time taken, the number of nodes searched and the nodes searched per second, followed by a summary on one line of
+ * key=value pairs so that runs of different versions can be compared (returns number of positions with incorrect results)
+ * 
+ * The transposition table is cleared before each position, so that each result is independent of the positions searched before.
+ */
+int runBenchmark(int tier)
+{
+    printf("%-12s %7s %5s %4s %5s %-24s %10s %14s %12s  %s\n", "Position", "Empties", "Depth", "Move", "Score", "Expected", "Time (s)",
+        "Nodes", "Nodes/s", "Result");
+    
+    int searched = 0;
+    int incorrect = 0;
+    double totalTime = 0;
+    unsigned long long totalNodes = 0;
+    for (int p = 0; p < BENCHMARK_POSITIONS; p++)
+    {
+        position* current = &benchmark[p];
+        if (current->tier > tier)
+        {
+            continue;
+        }
+        searched++;
+        loadBoard(current->tiles);
+        loadBoardAI();
+        int empties = BOARD_MAX * BOARD_MAX - featuresAI.tiles;
+        int depth = (current->depth == 0) ? empties : current->depth;
+        
+        // search position, timing with a clock that is not affected by changes of the system time
+        memset(table, 0, tableSize * sizeof(entry));
+        nodes = 0;
+        rootMove moves[BOARD_MAX * BOARD_MAX];
+        struct timespec start;
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int legalMoves = analyze(current->alignment, depth, 1, moves);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        
+        // result is correct if score is expected score and move is one of the expected best moves
+        char move[3] = "--";
+        int score = 0;
+        if (legalMoves > 0)
+        {
+            move[0] = moves[0].move % BOARD_MAX + 'A';
+            move[1] = moves[0].move / BOARD_MAX + '1';
+            score = moves[0].score;
+        }
+        bool correct = legalMoves > 0 && score == current->score && strstr(current->bestMoves, move) != NULL;
+        if (!correct)
+        {
+            incorrect++;
+        }
+        
+        char expected[32];
+        snprintf(expected, sizeof(expected), "%s %+d", current->bestMoves, current->score);
+        printf("%-12s %7d %5d %4s %+5d %-24s %10.3f %14llu %12.0f  %s\n", current->name, empties, depth, move, score, expected, time,
+            nodes, (time > 0) ? nodes / time : 0, correct ? "ok" : "WRONG");
+        fflush(stdout);
+        
+        totalTime += time;
+        totalNodes += nodes;
+    }
+    
+    printf("benchmark tier=%d positions=%d correct=%d time=%.3f nodes=%llu nps=%.0f selectivity=%d memory=%d\n", tier, searched,
+        searched - incorrect, totalTime, totalNodes, (totalTime > 0) ? totalNodes / totalTime : 0, selectivity, memoryMax);
+    
+    return incorrect;
+}
+
+/**
+ * allocate all memory of A.I. at once within the memory limit, report its use and generate random keys for hashing boards (returns
+ * false if memory could not be allocated)
+ * 
+ * With huge pages requested, explicit huge pages are tried first (which the system must have reserved), then transparent huge
+ * pages, then normal pages.  The memory is touched right away, so that the search never waits for the system to provide it.
+ */
+bool initMemory(void)
+{
+    // memory limit may not fit in size_t on 32-bit systems
+    if ((size_t) memoryMax > SIZE_MAX / (1024 * 1024))
+    {
+        return false;
+    }
+    memorySize = (size_t) memoryMax * 1024 * 1024;
+    memory = MAP_FAILED;
+    char* pages = "normal pages";
+    
+    // explicit huge pages can only back whole huge pages, so round memory down to stay within the limit
+    if (hugePages && memorySize >= HUGE_PAGE_SIZE)
+    {
+        memorySize -= memorySize % HUGE_PAGE_SIZE;
+#ifdef MAP_HUGETLB
+        memory = mmap(NULL, memorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        pages = "explicit huge pages";
+#endif
+    }
+    if (memory == MAP_FAILED)
+    {
+        memory = mmap(NULL, memorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            return false;
+        }
+        pages = "normal pages";
+#ifdef MADV_HUGEPAGE
+        if (hugePages && memorySize >= HUGE_PAGE_SIZE && madvise(memory, memorySize, MADV_HUGEPAGE) == 0)
+        {
+            pages = "transparent huge pages";
+        }
+#endif
+    }
+    memset(memory, 0, memorySize);
+    
+    // nodes of A.I. tree come first (rounded up to a whole cache line), then as many transposition table entries as fit
+    size_t treeSize = ((PLY_MAX + 2) * sizeof(node) + 63) / 64 * 64;
+    tree = memory;
+    table = (entry*) ((char*) memory + treeSize);
+    tableSize = (memorySize - treeSize) / sizeof(entry);
+    
+    fprintf(stderr, "A.I. memory: %.1f MB of %s (transposition table of %zu entries, %d tree levels)\n",
+        memorySize / (1024.0 * 1024.0), pages, tableSize, PLY_MAX + 2);
+    
+    // generate keys with xorshift generator from fixed seed, so that searches are reproducible
+    uint64_t random = 0x9e3779b97f4a7c15ULL;
+    for (int player = 0; player < 2; player++)
+    {
+        for (int tile = 0; tile < BOARD_MAX * BOARD_MAX; tile++)
+        {
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            tileKeys[player][tile] = random;
+        }
+    }
+    random ^= random << 13;
+    random ^= random >> 7;
+    random ^= random << 17;
+    whiteKey = random;
+    
+    return true;
+}
+
+/**
+ * search each legal move of player alignment on boardAI, one level deeper at a time up to given depth, and fill moves with the
+ * legal moves ranked by score (returns number of legal moves)
+ * 
+ * Only the best count moves are guaranteed exact scores and principal variations; every other move is searched with the count-th
+ * best score so far as bound, so its score may only be an upper bound.  Each deeper search reuses the results of the shallower
+ * searches and of the other root moves through the transposition table, which is much cheaper than count separate searches.
+ */
+int analyze(int alignment, int depth, int count, rootMove* moves)
+{
+    
+    // find legal moves
+    int legalMoves = 0;
+    for (int m = 0; m < BOARD_MAX; m++)
+    {
+        for (int n = 0; n < BOARD_MAX; n++)
+        {
+            if (isLegalAI(m, n, alignment) != 0)
+            {
+                moves[legalMoves].move = m * BOARD_MAX + n;
+                moves[legalMoves].pvLength = 0;
+                legalMoves++;
+            }
+        }
+    }
+    
+    for (int d = 1; d <= depth; d++)
+    {
+        for (int k = 0; k < legalMoves; k++)
+        {
+            
+            // search move with count-th best exact score of moves already searched to this depth as bound, since only higher scores matter
+            searchRootMove(&moves[k], alignment, d, rankBound(moves, k, count));
+        }
+        
+        // rank moves so that best moves are searched first at next depth
+        rankMoves(moves, legalMoves);
+    }
+    
+    return legalMoves;
+}
+
+/**
+ * search root move of player alignment on boardAI to given depth with bound as lower bound of the window (from perspective of
+ * player alignment), setting its score, whether the score is exact and its principal variation
+ */
+void searchRootMove(rootMove* move, int alignment, int depth, int bound)
+{
+    int m = move->move / BOARD_MAX;
+    int n = move->move % BOARD_MAX;
+    z = 0;
+    node* child = &tree[1];
+    int returnScore = minimax(child, m, n, alignment, depth - 1, (alignment == 1) ? bound : -65, (alignment == 1) ? 65 : -bound);
+    move->score = alignment * returnScore;
+    move->exact = move->score > bound;
+    
+    // principal variation is move followed by principal variation of child
+    move->pv[0] = move->move;
+    move->pvLength = 1;
+    if (move->exact)
+    {
+        for (int p = 0; p < child->pvLength; p++)
+        {
+            move->pv[p + 1] = child->pv[p];
+        }
+        move->pvLength += child->pvLength;
+    }
+}
+
+/**
+ * determine count-th best exact score of given root moves (or -65 if fewer than count moves have exact scores)
+ */
+int rankBound(rootMove* moves, int legalMoves, int count)
+{
+    int bound = 65;
+    int exactMoves = 0;
+    for (int a = 0; a < legalMoves; a++)
+    {
+        if (moves[a].exact)
+        {
+            int better = 0;
+            for (int b = 0; b < legalMoves; b++)
+            {
+                better += moves[b].exact && moves[b].score > moves[a].score;
+            }
+            if (better < count && moves[a].score < bound)
+            {
+                bound = moves[a].score;
+            }
+            exactMoves++;
+        }
+    }
+    return (exactMoves < count) ? -65 : bound;
+}
+
+/**
+ * sort root moves by score (exact scores first among equal scores), keeping order of equal moves
+ */
+void rankMoves(rootMove* moves, int legalMoves)
+{
+    for (int k = 1; k < legalMoves; k++)
+    {
+        rootMove current = moves[k];
+        int a = k - 1;
+        while (a >= 0 && (moves[a].score < current.score || (moves[a].score == current.score && !moves[a].exact && current.exact)))
+        {
+            moves[a + 1] = moves[a];
+            a--;
+        }
+        moves[a + 1] = current;
+    }
+}
+
+/**
+ * print best root moves of player alignment with their scores and principal variations
+ */
+void printAnalysis(int alignment, int depth, int count, rootMove* moves, int legalMoves)
+{
+    char* player = malloc(6);
+    getAlignment(alignment, player);
+    printf("Best moves for player %s (depth %d):\n", player, depth);
+    free(player);
+    
+    for (int k = 0; k < count && k < legalMoves; k++)
+    {
+        printf("%2d. %c%c %s%+3d  ", k + 1, moves[k].move % BOARD_MAX + 'A', moves[k].move / BOARD_MAX + '1', moves[k].exact ? "  " : "<=", moves[k].score);
+        for (int p = 0; p < moves[k].pvLength; p++)
+        {
+            char text[3];
+            moveText(moves[k].pv[p], text);
+            printf(" %s", text);
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+/**
+ * search each legal move of player alignment on boardAI to given depth on worker processes, and fill moves with the legal moves
+ * ranked by score like analyze (returns number of legal moves)
+ * 
+ * Moves are first ranked by a shallower local search, then handed out best first to idle workers with the count-th best exact score
+ * found so far as bound.  Whenever a result raises the bound, workers still searching with a lower bound are stopped and given their
+ * move again with the new bound, which mostly reuses the results already in their transposition tables.  Workers report while they
+ * search, so a worker that is silent for WORKER_TIMEOUT seconds is given up and its move handed out again.  Moves that are left when
+ * no worker can be reached any more are searched locally.
+ */
+int distribute(int alignment, int depth, int count, rootMove* moves)
+{
+    
+    // rank moves with shallower local search (shallow enough to be cheap compared to the full search)
+    if (depth <= 2)
+    {
+        return analyze(alignment, depth, count, moves);
+    }
+    int legalMoves = analyze(alignment, depth - 2, count, moves);
+    
+    // encode board for jobs sent to workers, using same characters as printboard
+    char tiles[BOARD_MAX * BOARD_MAX + 1];
+    for (int tile = 0; tile < BOARD_MAX * BOARD_MAX; tile++)
+    {
+        tiles[tile] = (boardAI[tile / BOARD_MAX][tile % BOARD_MAX] == 0) ? '-' : (boardAI[tile / BOARD_MAX][tile % BOARD_MAX] == 1) ? 'O' : 'X';
+    }
+    tiles[BOARD_MAX * BOARD_MAX] = '\0';
+    
+    // keep results of finished moves in order of arrival, and whether each move still has to be handed out
+    rootMove results[BOARD_MAX * BOARD_MAX];
+    int finished = 0;
+    bool waiting[BOARD_MAX * BOARD_MAX];
+    for (int k = 0; k < legalMoves; k++)
+    {
+        waiting[k] = true;
+    }
+    for (int w = 0; w < workerCount; w++)
+    {
+        workers[w].job = -1;
+        workers[w].resume = -1;
+    }
+    
+    char line[MESSAGE_MAX];
+    while (finished < legalMoves)
+    {
+        
+        // hand out waiting moves to idle workers, best first (but a stopped move goes back to the worker that stopped it)
+        int bound = rankBound(results, finished, count);
+        int live = 0;
+        for (int w = 0; w < workerCount; w++)
+        {
+            if (workers[w].socket < 0)
+            {
+                continue;
+            }
+            live++;
+            if (workers[w].job != -1)
+            {
+                continue;
+            }
+            int k = workers[w].resume;
+            if (k == -1 || !waiting[k])
+            {
+                k = -1;
+                for (int a = 0; a < legalMoves && k == -1; a++)
+                {
+                    if (waiting[a])
+                    {
+                        k = a;
+                    }
+                }
+            }
+            if (k == -1)
+            {
+                continue;
+            }
+            sprintf(line, "JOB %d %d %d %d %d %d %s", k, alignment, moves[k].move, depth, bound, selectivity, tiles);
+            if (!sendLine(workers[w].socket, line))
+            {
+                dropWorker(&workers[w], waiting);
+                live--;
+                continue;
+            }
+            waiting[k] = false;
+            workers[w].job = k;
+            workers[w].bound = bound;
+            workers[w].stopping = false;
+            workers[w].resume = -1;
+            workers[w].heard = time(NULL);
+        }
+        
+        // if no worker can be reached, search waiting moves locally
+        if (live == 0)
+        {
+            for (int k = 0; k < legalMoves; k++)
+            {
+                if (waiting[k])
+                {
+                    searchRootMove(&moves[k], alignment, depth, rankBound(results, finished, count));
+                    results[finished++] = moves[k];
+                    waiting[k] = false;
+                }
+            }
+            continue;
+        }
+        
+        // wait for message from any busy worker, but not longer than between two messages of a worker searching a job
+        struct pollfd polls[WORKERS_MAX];
+        for (int w = 0; w < workerCount; w++)
+        {
+            polls[w].fd = (workers[w].socket >= 0 && workers[w].job != -1) ? workers[w].socket : -1;
+            polls[w].events = POLLIN;
+            polls[w].revents = 0;
+        }
+        if (poll(polls, workerCount, HEARTBEAT_INTERVAL * 1000) < 0 && errno != EINTR)
+        {
+            
+            // if workers cannot be waited for at all, give up on them, so that the remaining moves are searched locally
+            for (int w = 0; w < workerCount; w++)
+            {
+                if (workers[w].socket >= 0)
+                {
+                    dropWorker(&workers[w], waiting);
+                }
+            }
+            continue;
+        }
+        
+        for (int w = 0; w < workerCount; w++)
+        {
+            if (polls[w].revents == 0)
+            {
+                continue;
+            }
+            
+            int received;
+            while ((received = receiveLine(&workers[w], line, false)) == 1)
+            {
+                workers[w].heard = time(NULL);
+                int job;
+                int score;
+                unsigned long long jobNodes;
+                int offset;
+                
+                // result of job (which may have arrived after job was asked to stop, but is still valid for the bound it was searched with)
+                if (sscanf(line, "RESULT %d %d %llu %n", &job, &score, &jobNodes, &offset) >= 3 && job == workers[w].job)
+                {
+                    rootMove* result = &moves[job];
+                    result->score = score;
+                    result->exact = score > workers[w].bound;
+                    
+                    // decode principal variation from coordinates
+                    result->pvLength = 0;
+                    char* coord = line + offset;
+                    char square[3];
+                    int used;
+                    while (result->pvLength < PLY_MAX && sscanf(coord, "%2s%n", square, &used) == 1)
+                    {
+                        result->pv[result->pvLength++] = (strcmp(square, "--") == 0) ? PASS : (square[1] - '1') * BOARD_MAX + (square[0] - 'A');
+                        coord += used;
+                    }
+                    
+                    results[finished++] = *result;
+                    nodes += jobNodes;
+                    workers[w].job = -1;
+                }
+                
+                // job stopped before it was finished, so hand it out again
+                else if (sscanf(line, "STOPPED %d %llu", &job, &jobNodes) == 2 && job == workers[w].job)
+                {
+                    waiting[job] = true;
+                    nodes += jobNodes;
+                    workers[w].job = -1;
+                    workers[w].resume = job;
+                }
+            }
+            
+            // if worker is gone, hand out its job again
+            if (received < 0)
+            {
+                dropWorker(&workers[w], waiting);
+            }
+        }
+        
+        // give up on busy workers that have not been heard from for too long, handing out their jobs again
+        for (int w = 0; w < workerCount; w++)
+        {
+            if (workers[w].socket >= 0 && workers[w].job != -1 && time(NULL) - workers[w].heard > WORKER_TIMEOUT)
+            {
+                dropWorker(&workers[w], waiting);
+            }
+        }
+        
+        // stop jobs searched with a lower bound than the current one, since they search a wider window than needed
+        bound = rankBound(results, finished, count);
+        for (int w = 0; w < workerCount; w++)
+        {
+            if (workers[w].socket >= 0 && workers[w].job != -1 && !workers[w].stopping && workers[w].bound < bound)
+            {
+                sprintf(line, "STOP %d", workers[w].job);
+                sendLine(workers[w].socket, line);
+                workers[w].stopping = true;
+            }
+        }
+        
+    }
+    
+    // rank moves by their results
+    for (int k = 0; k < legalMoves; k++)
+    {
+        moves[k] = results[k];
+    }
+    rankMoves(moves, legalMoves);
+    
+    return legalMoves;
+}
+
+/**
+ * connect to worker processes at comma-separated list of host:port addresses (returns false if any worker could not be reached)
+ */
+bool connectWorkers(char* addresses)
+{
+    for (char* address = strtok(addresses, ","); address != NULL; address = strtok(NULL, ","))
+    {
+        
+        // split address into host and port
+        char* colon = strrchr(address, ':');
+        if (colon == NULL || workerCount == WORKERS_MAX)
+        {
+            printf("Worker address %s should be host:port (at most %d workers).\n", address, WORKERS_MAX);
+            return false;
+        }
+        *colon = '\0';
+        
+        // look up host and connect to it
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo* info;
+        if (getaddrinfo(address, colon + 1, &hints, &info) != 0)
+        {
+            printf("Could not find worker %s:%s.\n", address, colon + 1);
+            return false;
+        }
+        int s = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (s < 0 || connect(s, info->ai_addr, info->ai_addrlen) < 0)
+        {
+            printf("Could not connect to worker %s:%s.\n", address, colon + 1);
+            freeaddrinfo(info);
+            return false;
+        }
+        freeaddrinfo(info);
+        
+        // also let the system detect a worker that has gone away while idle
+        int keepAlive = 1;
+        setsockopt(s, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(keepAlive));
+        
+        workers[workerCount].socket = s;
+        workers[workerCount].length = 0;
+        workers[workerCount].job = -1;
+        workerCount++;
+    }
+    return true;
+}
+
+/**
+ * in coordinator, disconnect from worker that is gone or cannot be reached, marking its job as waiting to be handed out again
+ */
+void dropWorker(connection* worker, bool* waiting)
+{
+    close(worker->socket);
+    worker->socket = -1;
+    if (worker->job != -1)
+    {
+        waiting[worker->job] = true;
+        worker->job = -1;
+    }
+    worker->resume = -1;
+}
+
+/**
+ * run as worker process, accepting connections from one coordinator at a time on given port and searching the jobs it sends
+ * 
+ * Each job is a root move to search with a bound, and is answered with its score, the number of nodes searched and its principal
+ * variation, or with the number of nodes searched if the coordinator asked to stop it.  The transposition table is kept between
+ * jobs, so a job that is stopped and sent again with a new bound reuses most of the work already done.
+ */
+int runWorker(int port)
+{
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (listener < 0 || setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0
+        || bind(listener, (struct sockaddr*) &address, sizeof(address)) < 0 || listen(listener, 1) < 0)
+    {
+        printf("Could not listen on port %d.\n", port);
+        return 1;
+    }
+    printf("Worker listening on port %d.\n", port);
+    fflush(stdout);
+    
+    while (true)
+    {
+        connection c;
+        c.socket = accept(listener, NULL, NULL);
+        c.length = 0;
+        if (c.socket < 0)
+        {
+            continue;
+        }
+        coordinator = &c;
+        int keepAlive = 1;
+        setsockopt(c.socket, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, sizeof(keepAlive));
+        
+        char line[MESSAGE_MAX];
+        while (receiveLine(&c, line, true) == 1)
+        {
+            
+            // ignore anything but jobs (e.g. requests to stop jobs that were already finished)
+            int alignment;
+            int depth;
+            int bound;
+            int level;
+            rootMove move;
+            char tiles[BOARD_MAX * BOARD_MAX + 1];
+            if (sscanf(line, "JOB %d %d %d %d %d %d %64s", &currentJob, &alignment, &move.move, &depth, &bound, &level, tiles) != 7
+                || strlen(tiles) != BOARD_MAX * BOARD_MAX || move.move < 0 || move.move >= BOARD_MAX * BOARD_MAX
+                || depth < 1 || depth > BOARD_MAX * BOARD_MAX || level < 0 || level >= MPC_LEVELS)
+            {
+                continue;
+            }
+            
+            // decode board and search move one level deeper at a time, so that deeper searches are ordered by shallower ones
+            loadBoard(tiles);
+            loadBoardAI();
+            selectivity = level;
+            stopSearch = false;
+            nodes = 0;
+            c.heard = time(NULL);
+            for (int d = 1; d <= depth && !stopSearch; d++)
+            {
+                searchRootMove(&move, alignment, d, bound);
+            }
+            
+            // answer with result, or with number of nodes if job was stopped
+            if (stopSearch)
+            {
+                sprintf(line, "STOPPED %d %llu", currentJob, nodes);
+            }
+            else
+            {
+                int length = sprintf(line, "RESULT %d %d %llu", currentJob, move.score, nodes);
+                for (int p = 0; p < move.pvLength; p++)
+                {
+                    char text[3];
+                    moveText(move.pv[p], text);
+                    length += sprintf(line + length, " %s", text);
+                }
+            }
+            currentJob = -1;
+            if (!sendLine(c.socket, line))
+            {
+                break;
+            }
+        }
+        
+        close(c.socket);
+        coordinator = NULL;
+    }
+}
+
+/**
+ * in worker process, check without waiting whether coordinator has asked to stop current job (or has gone away), and regularly tell
+ * coordinator that the job is still being searched, so that it can tell a busy worker from a lost one
+ */
+void checkStop(void)
+{
+    char line[MESSAGE_MAX];
+    if (time(NULL) - coordinator->heard >= HEARTBEAT_INTERVAL)
+    {
+        sprintf(line, "BUSY %d %llu", currentJob, nodes);
+        if (!sendLine(coordinator->socket, line))
+        {
+            stopSearch = true;
+        }
+        coordinator->heard = time(NULL);
+    }
+    
+    int received;
+    while ((received = receiveLine(coordinator, line, false)) == 1)
+    {
+        int job;
+        if (sscanf(line, "STOP %d", &job) == 1 && job == currentJob)
+        {
+            stopSearch = true;
+        }
+    }
+    if (received < 0)
+    {
+        stopSearch = true;
+    }
+}
+
+/**
+ * read next line of text received on connection into line (without newline), returning 1 if a line was read, 0 if no whole line
+ * has arrived yet (only if wait is false) and -1 if connection was closed or broken
+ */
+int receiveLine(connection* c, char* line, bool wait)
+{
+    while (true)
+    {
+        
+        // if buffer holds a whole line, move it from buffer to line
+        char* end = memchr(c->buffer, '\n', c->length);
+        if (end != NULL)
+        {
+            int length = end - c->buffer;
+            memcpy(line, c->buffer, length);
+            line[length] = '\0';
+            c->length -= length + 1;
+            memmove(c->buffer, end + 1, c->length);
+            return 1;
+        }
+        
+        // lines never fill the buffer, so a full buffer means connection is broken
+        if (c->length == MESSAGE_MAX)
+        {
+            return -1;
+        }
+        
+        // if not waiting, only read if something has arrived
+        if (!wait)
+        {
+            struct pollfd p;
+            p.fd = c->socket;
+            p.events = POLLIN;
+            if (poll(&p, 1, 0) <= 0)
+            {
+                return 0;
+            }
+        }
+        
+        ssize_t received = read(c->socket, c->buffer + c->length, MESSAGE_MAX - c->length);
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (received <= 0)
+        {
+            return -1;
+        }
+        c->length += received;
+    }
+}
+
+/**
+ * send line of text followed by newline on socket (returns false if connection is broken)
+ */
+bool sendLine(int socket, char* line)
+{
+    char message[MESSAGE_MAX + 1];
+    int length = snprintf(message, sizeof(message), "%s\n", line);
+    for (int sent = 0; sent < length; )
+    {
+        ssize_t written = write(socket, message + sent, length - sent);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            return false;
+        }
+        sent += written;
+    }
+    return true;
+}
+
+/**
+ * check if move is legal and return mask of tiles that would be flipped (zero if move is not legal), without changing boardAI
+ */
+uint64_t isLegalAI(int i, int j, int alignment)
+{
+    
+    // check to see if the tile is already full
+    if (boardAI[i][j] != 0)
+    {
+        return 0;
+    }
+    
+    // declare and initialize variable for returning tiles to be flipped
+    uint64_t flips = 0;
+    
+    // remember coordinates of tile to be checked
+    int i_origin = i;
+    int j_origin = j;
+    
+    // declare variables to store checking direction
+    int x;
+    int y;
+    
+    // iterate over possible horizontal checking increments (i.e., left, right or none)
+    for (int m = 0; m < 3; m++)
+    {
+        
+        // determine horizontal checking increment
+        switch (m)
+        {
+            case 0 :
+                x = -1;
+                break;
+            case 1 :
+                x = 0;
+                break;
+            case 2 :
+                x = 1;
+        }
+        
+        // check if column to be checked is out of bounds
+        if ((i_origin + x) < 0 || (i_origin + x) >= BOARD_MAX)
+        {
+            continue;
+        }
+        
+        // iterate over possible vertical checking increments (i.e., up, down or none)
+        for (int n = 0; n < 3; n++)
+        {
+            
+            // determine vertical checking increment
+            switch (n)
+            {
+                case 0 :
+                    y = -1;
+                    break;
+                case 1 :
+                    y = 0;
+                    break;
+                case 2 :
+                    y = 1;
+            }
+            
+            if (x == 0 && y == 0)
+            {
+                continue;
+            }
+            
+            // check if row to be checked is out of bounds
+            if ((j_origin + y) < 0 || (j_origin + y) >= BOARD_MAX)
+            {
+                continue;
+            }
+            
+            i = i_origin;
+            j = j_origin;
+            
             // iterate outwards in checking direction (as long as next tile has alignment that is opposite of origin tile) to determine if any pieces can be flipped
+            uint64_t line = 0;
             while(boardAI[i + x][j + y] == (alignment * (-1)))
             {
                 i += x;
                 j += y;
+                line |= 1ULL << (i * BOARD_MAX + j);
                 
                 // break if next tile is out of bounds
                 if ((i + x) < 0 || (i + x) >= BOARD_MAX || (j + y) < 0 || (j + y) >= BOARD_MAX)
@@ -756,64 +2239,478 @@ bool isLegalAI(int i, int j, int alignment)
                     break;
                 }
                 
-                // either flip affected tiles if next tile has same alignment as origin tile
+                // add tiles in checking direction to flipped tiles if next tile has same alignment as origin tile
                 if (boardAI[i + x][j + y] == alignment)
                 {
-                    
-                    // iterate backwards over tiles to be flipped
-                    while (i != i_origin || j != j_origin)
-                    {
-                        boardAI[i][j] *= -1;
-                        i -= x;
-                        j -= y;
-                    }
-                    legality = true;
+                    flips |= line;
                     break;
-                    
                 }
             }
         }
     }
     
-    // if at least one flip was made, "place" origin tile by setting it equal to alignment
-    if (legality == true)
+    return flips;
+    
+}
+
+/**
+ * check if there are any legal moves available on boardAI for player alignment
+ * 
+ * All directions are checked for all tiles at once using the tile masks: starting from the player's tiles, runs of the other
+ * player's tiles are followed in each direction, and an empty tile right after such a run is a legal move.
+ */
+bool isAnyMoveAvailableAI(int alignment)
+{
+    uint64_t own = featuresAI.tileMask[PLAYER(alignment)];
+    uint64_t other = featuresAI.tileMask[PLAYER(-alignment)];
+    uint64_t empty = ~(own | other);
+    for (int direction = 0; direction < 8; direction++)
     {
-        boardAI[i_origin][j_origin] = alignment;
+        
+        // a run of the other player's tiles is at most BOARD_MAX - 2 tiles long
+        uint64_t run = shiftTiles(own, direction) & other;
+        for (int k = 0; k < BOARD_MAX - 3; k++)
+        {
+            run |= shiftTiles(run, direction) & other;
+        }
+        if ((shiftTiles(run, direction) & empty) != 0)
+        {
+            return true;
+        }
     }
-    return legality;
+    return false;
+}
+
+/**
+ * determine current score
+ */
+int boardCountAI(void)
+{
+    return featuresAI.discs;
+}
+
+/**
+ * determine score of boardAI once the game is over, with the empty tiles counted for the winner
+ */
+int finalCountAI(void)
+{
+    int empties = BOARD_MAX * BOARD_MAX - featuresAI.tiles;
+    if (featuresAI.discs > 0)
+    {
+        return featuresAI.discs + empties;
+    }
+    if (featuresAI.discs < 0)
+    {
+        return featuresAI.discs - empties;
+    }
+    return 0;
+}
+
+/**
+ * execute move on boardAI if it is legal, updating features from the flipped tiles, and return mask of flipped tiles (zero if
+ * move is not legal)
+ */
+uint64_t makeMoveAI(int i, int j, int alignment)
+{
+    uint64_t flips = isLegalAI(i, j, alignment);
+    if (flips == 0)
+    {
+        return 0;
+    }
+    
+    // save features so that move can be unmade
+    featuresHistory[featuresAI.tiles] = featuresAI;
+    
+    // only the placed tile, the flipped tiles and their neighbours can change frontier and potential mobility, so remove their
+    // contributions before the move and add them back afterwards
+    uint64_t placed = 1ULL << (i * BOARD_MAX + j);
+    uint64_t changed = placed | neighbours(placed) | flips | neighbours(flips);
+    addFeaturesAI(changed, -1);
+    
+    // flip tiles and place origin tile
+    for (uint64_t tiles = flips; tiles != 0; tiles &= tiles - 1)
+    {
+        int tile = __builtin_ctzll(tiles);
+        boardAI[tile / BOARD_MAX][tile % BOARD_MAX] = alignment;
+        featuresAI.hash ^= tileKeys[0][tile] ^ tileKeys[1][tile];
+    }
+    boardAI[i][j] = alignment;
+    featuresAI.hash ^= tileKeys[PLAYER(alignment)][i * BOARD_MAX + j];
+    featuresAI.tileMask[PLAYER(alignment)] |= flips | placed;
+    featuresAI.tileMask[PLAYER(-alignment)] &= ~flips;
+    
+    addFeaturesAI(changed, 1);
+    
+    // each flipped tile and the placed tile count towards player alignment
+    featuresAI.discs += alignment * (2 * __builtin_popcountll(flips) + 1);
+    featuresAI.tiles++;
+    for (int line = 0; line < 4; line++)
+    {
+        lineEmpties[line][lineIndex(i, j, line)]--;
+    }
+    
+    updateStabilityAI(i, j, flips);
     
+    checkFeaturesAI();
+    
+    return flips;
 }
 
 /**
- * iterate over each tile of the game board to check if there are any legal moves available
+ * undo move on boardAI that flipped the given tiles and restore features from before the move
  */
-bool isAnyMoveAvailableAI(int alignment)
+void unmakeMoveAI(int i, int j, uint64_t flips)
+{
+    for (uint64_t tiles = flips; tiles != 0; tiles &= tiles - 1)
+    {
+        int tile = __builtin_ctzll(tiles);
+        boardAI[tile / BOARD_MAX][tile % BOARD_MAX] *= -1;
+    }
+    boardAI[i][j] = 0;
+    
+    for (int line = 0; line < 4; line++)
+    {
+        lineEmpties[line][lineIndex(i, j, line)]++;
+    }
+    featuresAI = featuresHistory[featuresAI.tiles - 1];
+    
+    checkFeaturesAI();
+}
+
+/**
+ * set board from tiles given as text (X for black, O for white and anything else for empty, from A1 to H1, then A2 to H2 and so on)
+ */
+void loadBoard(char* tiles)
+{
+    for (int tile = 0; tile < BOARD_MAX * BOARD_MAX; tile++)
+    {
+        board[tile / BOARD_MAX][tile % BOARD_MAX] = (tiles[tile] == 'O') ? 1 : (tiles[tile] == 'X') ? -1 : 0;
+    }
+}
+
+/**
+ * copy board to boardAI and compute its features
+ */
+void loadBoardAI(void)
+{
+    for (int m = 0; m < BOARD_MAX; m++)
+    {
+        for (int n = 0; n < BOARD_MAX; n++)
+        {
+            boardAI[m][n] = board[m][n];
+        }
+    }
+    initFeaturesAI();
+}
+
+/**
+ * compute features of boardAI from scratch (needed whenever boardAI is copied from board)
+ */
+void initFeaturesAI(void)
 {
+    for (int line = 0; line < 4; line++)
+    {
+        for (int index = 0; index < 2 * BOARD_MAX - 1; index++)
+        {
+            lineEmpties[line][index] = 0;
+        }
+    }
     for (int i = 0; i < BOARD_MAX; i++)
     {
         for (int j = 0; j < BOARD_MAX; j++)
         {
-            if (isLegalAI(i, j, alignment))
+            if (boardAI[i][j] == 0)
             {
-                return true;
+                for (int line = 0; line < 4; line++)
+                {
+                    lineEmpties[line][lineIndex(i, j, line)]++;
+                }
             }
         }
     }
-    return false;
+    computeFeaturesAI(&featuresAI);
 }
 
 /**
- * determine current score
+ * compute features of boardAI from scratch by iterating over each tile of the board (reference for the incremental updates)
  */
-int boardCountAI(void)
+void computeFeaturesAI(features* f)
 {
-    int count = 0;
+    memset(f, 0, sizeof(features));
+    
     for (int i = 0; i < BOARD_MAX; i++)
     {
         for (int j = 0; j < BOARD_MAX; j++)
         {
-            count += boardAI[i][j];
+            
+            // check which kinds of tiles are next to tile
+            bool nextToEmpty = false;
+            bool nextToBlack = false;
+            bool nextToWhite = false;
+            for (int x = -1; x <= 1; x++)
+            {
+                for (int y = -1; y <= 1; y++)
+                {
+                    if ((x != 0 || y != 0) && i + x >= 0 && i + x < BOARD_MAX && j + y >= 0 && j + y < BOARD_MAX)
+                    {
+                        nextToEmpty |= boardAI[i + x][j + y] == 0;
+                        nextToBlack |= boardAI[i + x][j + y] == -1;
+                        nextToWhite |= boardAI[i + x][j + y] == 1;
+                    }
+                }
+            }
+            
+            if (boardAI[i][j] != 0)
+            {
+                f->tileMask[PLAYER(boardAI[i][j])] |= 1ULL << (i * BOARD_MAX + j);
+                f->hash ^= tileKeys[PLAYER(boardAI[i][j])][i * BOARD_MAX + j];
+                f->discs += boardAI[i][j];
+                f->tiles++;
+                f->frontier[PLAYER(boardAI[i][j])] += nextToEmpty;
+            }
+            else
+            {
+                f->potentialMobility[PLAYER(-1)] += nextToWhite;
+                f->potentialMobility[PLAYER(1)] += nextToBlack;
+            }
         }
     }
-    return count;
+    
+    // a tile is stable if it is stable along each line through it, so repeat until no more stable tiles are found
+    bool found = true;
+    while (found)
+    {
+        found = false;
+        for (int i = 0; i < BOARD_MAX; i++)
+        {
+            for (int j = 0; j < BOARD_MAX; j++)
+            {
+                if (boardAI[i][j] == 0 || (f->stableMask & (1ULL << (i * BOARD_MAX + j))) != 0)
+                {
+                    continue;
+                }
+                
+                // check each line through tile for empty tiles
+                bool full[4];
+                for (int line = 0; line < 4; line++)
+                {
+                    uint64_t tiles = lineMaskAI(i, j, line);
+                    full[line] = true;
+                    for (; tiles != 0; tiles &= tiles - 1)
+                    {
+                        int tile = __builtin_ctzll(tiles);
+                        if (boardAI[tile / BOARD_MAX][tile % BOARD_MAX] == 0)
+                        {
+                            full[line] = false;
+                        }
+                    }
+                }
+                
+                if (isStableAI(i, j, f->stableMask, full))
+                {
+                    f->stableMask |= 1ULL << (i * BOARD_MAX + j);
+                    f->stable[PLAYER(boardAI[i][j])]++;
+                    found = true;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * add frontier and potential mobility of given tiles of boardAI to features (or remove them if sign is -1)
+ */
+void addFeaturesAI(uint64_t tiles, int sign)
+{
+    uint64_t black = featuresAI.tileMask[PLAYER(-1)];
+    uint64_t white = featuresAI.tileMask[PLAYER(1)];
+    uint64_t empty = ~(black | white);
+    uint64_t nextToEmpty = neighbours(empty);
+    
+    featuresAI.frontier[PLAYER(-1)] += sign * __builtin_popcountll(tiles & black & nextToEmpty);
+    featuresAI.frontier[PLAYER(1)] += sign * __builtin_popcountll(tiles & white & nextToEmpty);
+    featuresAI.potentialMobility[PLAYER(-1)] += sign * __builtin_popcountll(tiles & empty & neighbours(white));
+    featuresAI.potentialMobility[PLAYER(1)] += sign * __builtin_popcountll(tiles & empty & neighbours(black));
+}
+
+/**
+ * find tiles made stable by move at i, j that flipped the given tiles
+ * 
+ * Stable tiles stay stable, so only the placed and flipped tiles, tiles on lines filled by the move and neighbours of newly stable
+ * tiles need to be checked.  Of the placed and flipped tiles, only those on the edge of the board, next to a stable tile or on a
+ * filled line can be anchored along every line.
+ */
+void updateStabilityAI(int i, int j, uint64_t flips)
+{
+    uint64_t candidates = (1ULL << (i * BOARD_MAX + j)) | flips;
+    uint64_t anchored = EDGES | neighbours(featuresAI.stableMask);
+    bool full[4];
+    for (int line = 0; line < 4; line++)
+    {
+        if (lineEmpties[line][lineIndex(i, j, line)] == 0)
+        {
+            candidates |= lineMaskAI(i, j, line);
+            anchored |= lineMaskAI(i, j, line);
+        }
+    }
+    
+    candidates &= anchored & ~featuresAI.stableMask;
+    while (candidates != 0)
+    {
+        int tile = __builtin_ctzll(candidates);
+        candidates &= candidates - 1;
+        int m = tile / BOARD_MAX;
+        int n = tile % BOARD_MAX;
+        if (boardAI[m][n] == 0)
+        {
+            continue;
+        }
+        
+        for (int line = 0; line < 4; line++)
+        {
+            full[line] = lineEmpties[line][lineIndex(m, n, line)] == 0;
+        }
+        if (isStableAI(m, n, featuresAI.stableMask, full))
+        {
+            featuresAI.stableMask |= 1ULL << tile;
+            featuresAI.stable[PLAYER(boardAI[m][n])]++;
+            candidates |= neighbours(1ULL << tile) & ~featuresAI.stableMask;
+        }
+    }
+}
+
+/**
+ * check if tile i, j of boardAI is stable given the tiles already known to be stable and which lines through it are full
+ * 
+ * A tile can only be flipped along a line that still has an empty tile, and cannot be flipped along a line where it is next to
+ * the edge of the board or to a stable tile of the same alignment.
+ */
+bool isStableAI(int i, int j, uint64_t stableMask, bool full[4])
+{
+    for (int line = 0; line < 4; line++)
+    {
+        if (full[line])
+        {
+            continue;
+        }
+        
+        bool anchored = false;
+        for (int sign = -1; sign <= 1; sign += 2)
+        {
+            int m = i + sign * lineX[line];
+            int n = j + sign * lineY[line];
+            if (m < 0 || m >= BOARD_MAX || n < 0 || n >= BOARD_MAX)
+            {
+                anchored = true;
+            }
+            else if (boardAI[m][n] == boardAI[i][j] && (stableMask & (1ULL << (m * BOARD_MAX + n))) != 0)
+            {
+                anchored = true;
+            }
+        }
+        if (!anchored)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * determine index of row, column, diagonal or anti-diagonal through tile i, j
+ */
+int lineIndex(int i, int j, int line)
+{
+    switch (line)
+    {
+        case 0 :
+            return i;
+        case 1 :
+            return j;
+        case 2 :
+            return i - j + BOARD_MAX - 1;
+        default :
+            return i + j;
+    }
+}
+
+/**
+ * determine mask of tiles on row, column, diagonal or anti-diagonal through tile i, j
+ */
+uint64_t lineMaskAI(int i, int j, int line)
+{
+    
+    // walk back to the edge of the board, then forward to the other edge
+    while (i - lineX[line] >= 0 && i - lineX[line] < BOARD_MAX && j - lineY[line] >= 0 && j - lineY[line] < BOARD_MAX)
+    {
+        i -= lineX[line];
+        j -= lineY[line];
+    }
+    uint64_t tiles = 0;
+    while (i >= 0 && i < BOARD_MAX && j >= 0 && j < BOARD_MAX)
+    {
+        tiles |= 1ULL << (i * BOARD_MAX + j);
+        i += lineX[line];
+        j += lineY[line];
+    }
+    return tiles;
+}
+
+/**
+ * determine mask of tiles next to any of the given tiles
+ */
+uint64_t neighbours(uint64_t tiles)
+{
+    return (tiles << BOARD_MAX) | (tiles >> BOARD_MAX)
+        | (((tiles << 1) | (tiles << (BOARD_MAX + 1)) | (tiles >> (BOARD_MAX - 1))) & ~COLUMN_A)
+        | (((tiles >> 1) | (tiles >> (BOARD_MAX + 1)) | (tiles << (BOARD_MAX - 1))) & ~COLUMN_H);
+}
+
+/**
+ * move each of the given tiles one step in direction (0 to 7: right, left, down, up and the four diagonals), dropping tiles that
+ * would leave the board
+ */
+uint64_t shiftTiles(uint64_t tiles, int direction)
+{
+    switch (direction)
+    {
+        case 0 :
+            return (tiles << 1) & ~COLUMN_A;
+        case 1 :
+            return (tiles >> 1) & ~COLUMN_H;
+        case 2 :
+            return tiles << BOARD_MAX;
+        case 3 :
+            return tiles >> BOARD_MAX;
+        case 4 :
+            return (tiles << (BOARD_MAX + 1)) & ~COLUMN_A;
+        case 5 :
+            return (tiles << (BOARD_MAX - 1)) & ~COLUMN_H;
+        case 6 :
+            return (tiles >> (BOARD_MAX - 1)) & ~COLUMN_A;
+        default :
+            return (tiles >> (BOARD_MAX + 1)) & ~COLUMN_H;
+    }
+}
+
+/**
+ * check incrementally updated features of boardAI against features computed from scratch (only when compiled with -DCHECK_FEATURES)
+ */
+void checkFeaturesAI(void)
+{
+#ifdef CHECK_FEATURES
+    features reference;
+    computeFeaturesAI(&reference);
+    assert(reference.tileMask[0] == featuresAI.tileMask[0] && reference.tileMask[1] == featuresAI.tileMask[1]);
+    assert(reference.stableMask == featuresAI.stableMask);
+    assert(reference.hash == featuresAI.hash);
+    assert(reference.discs == featuresAI.discs);
+    assert(reference.tiles == featuresAI.tiles);
+    for (int player = 0; player < 2; player++)
+    {
+        assert(reference.frontier[player] == featuresAI.frontier[player]);
+        assert(reference.potentialMobility[player] == featuresAI.potentialMobility[player]);
+        assert(reference.stable[player] == featuresAI.stable[player]);
+    }
+#endif
 }
\ No newline at end of file